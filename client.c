@@ -9,6 +9,7 @@
 #include <time.h>
 #include <fcntl.h>
 #include <semaphore.h>
+#include <limits.h>
 
   
 /* 
@@ -29,6 +30,9 @@ void printUsageAndExit(char *executable) {
     fprintf(stderr, "Usage: %s --import -k <key> -v <value>\n", executable);
     fprintf(stderr, "%s --get -k <key>\n", executable);
     fprintf(stderr, "%s --delete -k <key>\n", executable);
+    fprintf(stderr, "%s --scan [--cursor <cursor>] [--count <count>] [--prefix <prefix>]\n", executable);
+    fprintf(stderr, "%s --load <file>\n", executable);
+    fprintf(stderr, "%s --stats\n", executable);
     fprintf(stderr, "%s --shutdown\n", executable);
     exit(EXIT_FAILURE);
 }
@@ -62,9 +66,15 @@ int main(int argc, char **argv) {
     int isInsert = 0;
     int isGet = 0;
     int isDelete = 0;
+    int isScan = 0;
+    int isStats = 0;
     int shutDown = 0;
     char *key = NULL;
     char *value = NULL;
+    char *cursor = "0";
+    char *count = "10";
+    char *prefix = NULL;
+    char *load_path = NULL;
 
     // read options to configure the operation properly
     int long_option;
@@ -74,12 +84,18 @@ int main(int argc, char **argv) {
         {"delete", no_argument, NULL, 'd'},
         {"key", required_argument, NULL, 'k'},
         {"value", optional_argument, NULL, 'v'},
+        {"scan", no_argument, NULL, 'c'},
+        {"cursor", required_argument, NULL, 'u'},
+        {"count", required_argument, NULL, 'n'},
+        {"prefix", required_argument, NULL, 'p'},
+        {"load", required_argument, NULL, 'l'},
+        {"stats", no_argument, NULL, 't'},
         {"shutdown", no_argument, NULL, 's'},
         {"help", no_argument, NULL, 'h'},
         {NULL, 0, NULL, 0}
     };
 
-    while ((long_option = getopt_long(argc, argv, "igdk:v:h", long_options, NULL)) != -1) {
+    while ((long_option = getopt_long(argc, argv, "igdck:v:u:n:p:l:th", long_options, NULL)) != -1) {
         switch (long_option) {
             case 'i':
                 isInsert = 1;
@@ -96,6 +112,24 @@ int main(int argc, char **argv) {
             case 'v':
                 value = optarg;
                 break;
+            case 'c':
+                isScan = 1;
+                break;
+            case 'u':
+                cursor = optarg;
+                break;
+            case 'n':
+                count = optarg;
+                break;
+            case 'p':
+                prefix = optarg;
+                break;
+            case 'l':
+                load_path = optarg;
+                break;
+            case 't':
+                isStats = 1;
+                break;
             case 's':
                 shutDown = 1;
                 break;
@@ -104,15 +138,15 @@ int main(int argc, char **argv) {
         }
     }
 
-    if(isInsert + isGet + isDelete + shutDown < 1) {
-        fprintf(stderr, "At least one of the arguments -i (--import), -g (--get) or -d (--delete) must be specified!");
+    if(isInsert + isGet + isDelete + isScan + (load_path != NULL) + isStats + shutDown < 1) {
+        fprintf(stderr, "At least one of the arguments -i (--import), -g (--get), -d (--delete), -c (--scan), -l (--load) or -t (--stats) must be specified!");
         printUsageAndExit(argv[0]);
-    } else if(isInsert + isGet + isDelete + shutDown > 1) {
-        fprintf(stderr, "Only one of the arguments -i (--import), -g (--get) or -d (--delete) must be specified!");
+    } else if(isInsert + isGet + isDelete + isScan + (load_path != NULL) + isStats + shutDown > 1) {
+        fprintf(stderr, "Only one of the arguments -i (--import), -g (--get), -d (--delete), -c (--scan), -l (--load) or -t (--stats) must be specified!");
         printUsageAndExit(argv[0]);
     }
 
-    if(!shutDown && key == NULL) {
+    if(!shutDown && !isScan && load_path == NULL && !isStats && key == NULL) {
         fprintf(stderr, "Key parameter is required!\n");
         printUsageAndExit(argv[0]);
     }
@@ -150,7 +184,7 @@ int main(int argc, char **argv) {
     // this will be used to differentiate in the server when one or more client processes 
     // overwrite the shm with the same content as before
     size_t cmd_length = strlen(random_identifier) + 1; // + newline
-    // cmd regex: [igd]\nkey(\nvalue)?
+    // cmd regex: [igd]\nkey(\nvalue)? or c\ncursor\ncount(\nprefix)? or l\npath or t
     if(isInsert) {
         // composing the command in the form
         // i\nkey\nvalue
@@ -194,6 +228,60 @@ int main(int argc, char **argv) {
 
         writeToServer(shm, cmd, cmd_length);
 
+        fprintf(stdout, "CMD: %s", cmd);
+    } else if(isScan) {
+        //composing the command in the form
+        // c\ncursor\ncount(\nprefix)?
+        // size is 1 char cmd_letter + 2 chars newline + cursor + count + (1 char newline + prefix) + 1 terminal char
+        cmd_length += 4 + strlen(cursor) + strlen(count) + (prefix == NULL ? 0 : 1 + strlen(prefix));
+        char cmd[cmd_length];
+
+        strcpy(cmd, random_identifier);
+        strcat(cmd, "\nc\n");
+        strcat(cmd, cursor);
+        strcat(cmd, "\n");
+        strcat(cmd, count);
+        if(prefix != NULL) {
+            strcat(cmd, "\n");
+            strcat(cmd, prefix);
+        }
+
+        writeToServer(shm, cmd, cmd_length);
+
+        fprintf(stdout, "CMD: %s", cmd);
+    } else if(load_path != NULL) {
+        // the server runs in another working directory, so send it an absolute path
+        char absolute_path[PATH_MAX];
+        if(realpath(load_path, absolute_path) == NULL) {
+            perror("Could not resolve the path of the file to load!");
+            exit(EXIT_FAILURE);
+        }
+
+        //composing the command in the form
+        // l\npath
+        // size is 1 char cmd_letter + 1 char newline + size of path + 1 terminal char
+        cmd_length += 3 + strlen(absolute_path);
+        char cmd[cmd_length];
+
+        strcpy(cmd, random_identifier);
+        strcat(cmd, "\nl\n");
+        strcat(cmd, absolute_path);
+
+        writeToServer(shm, cmd, cmd_length);
+
+        fprintf(stdout, "CMD: %s", cmd);
+    } else if(isStats) {
+        //composing the command in the form
+        // t\n
+        // size is 1 char cmd_letter + 1 char newline + 1 terminal char
+        cmd_length += 3;
+        char cmd[cmd_length];
+
+        strcpy(cmd, random_identifier);
+        strcat(cmd, "\nt\n");
+
+        writeToServer(shm, cmd, cmd_length);
+
         fprintf(stdout, "CMD: %s", cmd);
     } else {
         char *cmd = "q\n";
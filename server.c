@@ -9,6 +9,11 @@
 #include <fcntl.h>
 #include <semaphore.h>
 #include <errno.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
   
 /* 
  * 4KB shared memory segment
@@ -23,6 +28,35 @@
  */
 #define SERVER_SEM_NAME "/chained_hash_table.sem"
 
+/*
+ * Upper bound of buckets visited by a single scan step, relative to the
+ * requested page size, such that sparse tables do not make a step expensive
+ */
+#define SCAN_EMPTY_BUCKETS_FACTOR 10
+
+/*
+ * Upper bound of bulk load threads per online CPU
+ * Every worker needs a slot on the stack and a list per other worker,
+ * so more threads than this only cost memory
+ */
+#define BULK_LOAD_THREADS_PER_CPU 4
+
+/*
+ * Parameters of the built-in LZ77 codec used for value compression
+ * Matches are searched with a hash table of 2^LZ_HASH_BITS positions and
+ * must be at least LZ_MIN_MATCH bytes long and at most LZ_MAX_OFFSET bytes back
+ */
+#define LZ_HASH_BITS 12
+#define LZ_MIN_MATCH 4
+#define LZ_MAX_OFFSET 65535
+
+/*
+ * Only every COMPRESSION_TIMING_SAMPLE_RATE-th compression and decompression
+ * is timed (and counted that many times), since reading the CPU clock costs
+ * a good share of compressing a small value
+ */
+#define COMPRESSION_TIMING_SAMPLE_RATE 64
+
 /*
  * Structure for each node in the linked list used to implement a chained hash table
  *
@@ -34,16 +68,43 @@ struct Node {
     // adding the dynamically allocated size as well, since void* cannot be deferenced in c
     size_t key_size;
     void* value;
+    // size of the original value, even if it is stored compressed
     size_t value_size;
+    // if set, value holds stored_size bytes compressed with lzCompress
+    int compressed;
+    size_t stored_size;
     struct Node* next;
 };
 
+/*
+ * Counters of the value compression, used to tune the compression threshold
+ */
+struct CompressionStats {
+    // values currently stored compressed and their size before and after compression
+    size_t compressed_values;
+    size_t raw_bytes;
+    size_t stored_bytes;
+    // values currently stored raw, since they are above the threshold but did not get smaller
+    size_t incompressible_values;
+    // cumulative number of compressions and decompressions and CPU time spent in the codec
+    size_t compress_calls;
+    size_t decompressed_values;
+    double compress_seconds;
+    double decompress_seconds;
+};
+
 /*
  * Structure for the chained hash table
  */
 struct ChainedHashTable {
     size_t size;
     struct Node** table;
+    // values of at least this size are compressed, 0 disables the compression
+    size_t compress_threshold;
+    struct CompressionStats stats;
+    // buffer holding the last decompressed value returned by get
+    void* scratch;
+    size_t scratch_size;
 };
 
 /*
@@ -82,6 +143,180 @@ int hash(void* key, size_t key_size, size_t table_size) {
     }
 }
 
+/*
+ * Helper function to write the extension bytes of a literal or match length
+ * which did not fit in the 4 bits of the token
+ */
+unsigned char* lzWriteLength(unsigned char* out, size_t length) {
+    for (length -= 15; length >= 255; length -= 255) {
+        *out++ = 255;
+    }
+    *out++ = (unsigned char)length;
+
+    return out;
+}
+
+/*
+ * Helper function to write one sequence of the compressed block
+ * A match_length of 0 marks the last sequence, holding only literals
+ * Returns NULL if the sequence does not fit before out_end
+ */
+unsigned char* lzWriteSequence(unsigned char* out, unsigned char* out_end, unsigned char* literals, size_t literal_length, size_t offset, size_t match_length) {
+    size_t match_code = match_length == 0 ? 0 : match_length - LZ_MIN_MATCH;
+    size_t needed = 1 + literal_length + literal_length / 255 + 1 + (match_length == 0 ? 0 : 2 + match_code / 255 + 1);
+    if (needed > (size_t)(out_end - out)) {
+        return NULL;
+    }
+
+    unsigned char* token = out++;
+    *token = (literal_length < 15 ? literal_length : 15) << 4;
+    if (literal_length >= 15) {
+        out = lzWriteLength(out, literal_length);
+    }
+    memcpy(out, literals, literal_length);
+    out += literal_length;
+
+    if (match_length != 0) {
+        *out++ = offset & 0xff;
+        *out++ = offset >> 8;
+        *token |= match_code < 15 ? match_code : 15;
+        if (match_code >= 15) {
+            out = lzWriteLength(out, match_code);
+        }
+    }
+
+    return out;
+}
+
+/*
+ * Compress src with a simple LZ77 codec (block format similar to LZ4)
+ *
+ * Every sequence is a token (4 bits literal length, 4 bits match length),
+ * the literals, a 2 byte offset and the match, longer lengths are continued
+ * with extra bytes. Returns the compressed size or 0 if the result would
+ * not be smaller than dst_capacity.
+ */
+size_t lzCompress(unsigned char* src, size_t src_size, unsigned char* dst, size_t dst_capacity) {
+    // smaller hash table for small values, so clearing it does not cost more than the compression
+    uint32_t positions[1 << LZ_HASH_BITS];
+    int hash_bits = LZ_HASH_BITS;
+    while (hash_bits > 8 && ((size_t)1 << hash_bits) > src_size) {
+        hash_bits--;
+    }
+    memset(positions, 0, sizeof(uint32_t) << hash_bits);
+
+    unsigned char* out = dst;
+    unsigned char* out_end = dst + dst_capacity;
+    size_t anchor = 0;
+    size_t pos = 0;
+
+    while (pos + LZ_MIN_MATCH <= src_size) {
+        uint32_t sequence;
+        memcpy(&sequence, src + pos, sizeof(sequence));
+        uint32_t hash_index = (sequence * 2654435761u) >> (32 - hash_bits);
+        size_t candidate = positions[hash_index];
+        positions[hash_index] = (uint32_t)pos;
+
+        if (candidate >= pos || pos - candidate > LZ_MAX_OFFSET || memcmp(src + candidate, src + pos, LZ_MIN_MATCH) != 0) {
+            pos++;
+            continue;
+        }
+
+        size_t match_length = LZ_MIN_MATCH;
+        while (pos + match_length < src_size && src[candidate + match_length] == src[pos + match_length]) {
+            match_length++;
+        }
+
+        out = lzWriteSequence(out, out_end, src + anchor, pos - anchor, pos - candidate, match_length);
+        if (out == NULL) {
+            return 0;
+        }
+        pos += match_length;
+        anchor = pos;
+    }
+
+    out = lzWriteSequence(out, out_end, src + anchor, src_size - anchor, 0, 0);
+    if (out == NULL) {
+        return 0;
+    }
+
+    return out - dst;
+}
+
+/*
+ * Helper function to read the extension bytes of a literal or match length
+ */
+size_t lzReadLength(unsigned char** in, unsigned char* in_end, size_t length) {
+    if (length != 15) {
+        return length;
+    }
+
+    while (*in < in_end) {
+        unsigned char byte = *(*in)++;
+        length += byte;
+        if (byte != 255) {
+            break;
+        }
+    }
+
+    return length;
+}
+
+/*
+ * Decompress a block created by lzCompress into dst of exactly dst_size bytes
+ * Returns 0 on success and -1 if the block is corrupt
+ */
+int lzDecompress(unsigned char* src, size_t src_size, unsigned char* dst, size_t dst_size) {
+    unsigned char* in = src;
+    unsigned char* in_end = src + src_size;
+    unsigned char* out = dst;
+    unsigned char* out_end = dst + dst_size;
+
+    while (in < in_end) {
+        unsigned char token = *in++;
+
+        size_t literal_length = lzReadLength(&in, in_end, token >> 4);
+        if (literal_length > (size_t)(in_end - in) || literal_length > (size_t)(out_end - out)) {
+            return -1;
+        }
+        memcpy(out, in, literal_length);
+        in += literal_length;
+        out += literal_length;
+
+        // the last sequence holds only literals
+        if (in == in_end) {
+            break;
+        }
+
+        if (in_end - in < 2) {
+            return -1;
+        }
+        size_t offset = in[0] | (in[1] << 8);
+        in += 2;
+        size_t match_length = lzReadLength(&in, in_end, token & 0x0f) + LZ_MIN_MATCH;
+        if (offset == 0 || offset > (size_t)(out - dst) || match_length > (size_t)(out_end - out)) {
+            return -1;
+        }
+
+        // byte by byte, since the match may overlap with the bytes it produces
+        unsigned char* match = out - offset;
+        for (size_t i = 0; i < match_length; i++) {
+            *out++ = *match++;
+        }
+    }
+
+    return out == out_end ? 0 : -1;
+}
+
+/*
+ * Helper function to measure the CPU time spent by the calling thread
+ */
+double threadCpuSeconds() {
+    struct timespec now;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
 /*
  * Helper function to initialize a new node with given key and value pair and their sizes
  */
@@ -92,6 +327,8 @@ struct Node* createNode(void* key, void* value, size_t key_size, size_t value_si
     newNode->key_size = key_size;
     newNode->value = malloc(value_size);
     newNode->value_size = value_size;
+    newNode->compressed = 0;
+    newNode->stored_size = value_size;
     newNode->next = NULL;
 
     // copy key and value data to the node 
@@ -112,6 +349,86 @@ void freeNode(struct Node* node) {
     return;
 }
 
+/*
+ * Helper function to store the value of a node compressed, if it is at least
+ * threshold bytes big (0 disables the compression) and gets smaller
+ */
+void compressNodeValue(struct Node* node, size_t threshold, struct CompressionStats* stats) {
+    if (threshold == 0 || node->compressed || node->value_size < threshold) {
+        return;
+    }
+
+    int timed = stats->compress_calls++ % COMPRESSION_TIMING_SAMPLE_RATE == 0;
+    double start = timed ? threadCpuSeconds() : 0;
+    unsigned char* compressed = (unsigned char*)malloc(node->value_size);
+    size_t compressed_size = lzCompress(node->value, node->value_size, compressed, node->value_size - 1);
+    if (timed) {
+        stats->compress_seconds += (threadCpuSeconds() - start) * COMPRESSION_TIMING_SAMPLE_RATE;
+    }
+
+    if (compressed_size == 0) {
+        stats->incompressible_values++;
+        free(compressed);
+        return;
+    }
+
+    stats->compressed_values++;
+    stats->raw_bytes += node->value_size;
+    stats->stored_bytes += compressed_size;
+
+    free(node->value);
+    node->value = realloc(compressed, compressed_size);
+    node->compressed = 1;
+    node->stored_size = compressed_size;
+}
+
+/*
+ * Helper function to free the value of a node and remove it from the
+ * counters of the values stored by the table
+ */
+void freeNodeValue(struct Node* node, size_t threshold, struct CompressionStats* stats) {
+    if (node->compressed) {
+        stats->compressed_values--;
+        stats->raw_bytes -= node->value_size;
+        stats->stored_bytes -= node->stored_size;
+    } else if (threshold != 0 && node->value_size >= threshold) {
+        stats->incompressible_values--;
+    }
+
+    free(node->value);
+    node->value = NULL;
+}
+
+/*
+ * Helper function to move the value of source to target and free source
+ */
+void replaceNodeValue(struct Node* target, struct Node* source, size_t threshold, struct CompressionStats* stats) {
+    freeNodeValue(target, threshold, stats);
+    target->value = source->value;
+    target->value_size = source->value_size;
+    target->compressed = source->compressed;
+    target->stored_size = source->stored_size;
+
+    source->value = NULL;
+    freeNode(source);
+}
+
+/*
+ * Helper function to add the compression counters of source to target
+ * The counters of the stored values of the bulk load workers may wrap around
+ * on their own (a worker frees values another worker compressed), but their sum is exact
+ */
+void addCompressionStats(struct CompressionStats* target, struct CompressionStats* source) {
+    target->compressed_values += source->compressed_values;
+    target->raw_bytes += source->raw_bytes;
+    target->stored_bytes += source->stored_bytes;
+    target->incompressible_values += source->incompressible_values;
+    target->compress_calls += source->compress_calls;
+    target->decompressed_values += source->decompressed_values;
+    target->compress_seconds += source->compress_seconds;
+    target->decompress_seconds += source->decompress_seconds;
+}
+
 /*
  * Helper function to initialize the chained hash table properly
  */
@@ -119,6 +436,10 @@ struct ChainedHashTable* initializeHashTable(size_t size) {
     struct ChainedHashTable* cht = (struct ChainedHashTable*)malloc(sizeof(struct ChainedHashTable));
     cht->size = size;
     cht->table = (struct Node**)malloc(size * sizeof(struct Node*));
+    cht->compress_threshold = 0;
+    memset(&cht->stats, 0, sizeof(cht->stats));
+    cht->scratch = NULL;
+    cht->scratch_size = 0;
 
     for (int i = 0; i < size; i++) {
         cht->table[i] = NULL;
@@ -135,8 +456,9 @@ struct ChainedHashTable* initializeHashTable(size_t size) {
 void insert(struct ChainedHashTable* cht, void* key, void* value, size_t key_size, size_t value_size) {
     int index =  hash(key, key_size, cht->size);
 
-    // Create a new node
+    // Create a new node, its value is compressed if enabled
     struct Node* newNode = createNode(key, value, key_size, value_size);
+    compressNodeValue(newNode, cht->compress_threshold, &cht->stats);
     
     // If the bucket is empty, insert the new node
     if (cht->table[index] == NULL) {
@@ -146,9 +468,7 @@ void insert(struct ChainedHashTable* cht, void* key, void* value, size_t key_siz
         struct Node* current = cht->table[index];
         while(current != NULL) {
             if(memcmp(current->key, key, current->key_size) == 0) {
-                current->value = (char *)realloc(current->value, value_size);
-                memcpy(current->value, value, value_size);
-                free(newNode);
+                replaceNodeValue(current, newNode, cht->compress_threshold, &cht->stats);
                 return;
             }
 
@@ -160,9 +480,40 @@ void insert(struct ChainedHashTable* cht, void* key, void* value, size_t key_siz
     }
 }
 
+/*
+ * Helper function to access the original value of a node
+ * Compressed values are decompressed into the scratch buffer of the table,
+ * which stays valid until the next compressed value is accessed
+ */
+void* nodeValue(struct ChainedHashTable* cht, struct Node* node) {
+    if (!node->compressed) {
+        return node->value;
+    }
+
+    if (cht->scratch_size < node->value_size) {
+        cht->scratch = realloc(cht->scratch, node->value_size);
+        cht->scratch_size = node->value_size;
+    }
+
+    int timed = cht->stats.decompressed_values++ % COMPRESSION_TIMING_SAMPLE_RATE == 0;
+    double start = timed ? threadCpuSeconds() : 0;
+    int result = lzDecompress(node->value, node->stored_size, cht->scratch, node->value_size);
+    if (timed) {
+        cht->stats.decompress_seconds += (threadCpuSeconds() - start) * COMPRESSION_TIMING_SAMPLE_RATE;
+    }
+
+    if (result != 0) {
+        fprintf(stderr, "ATTENTION: Compressed value of key %s is corrupt!\n", (char*)node->key);
+        return NULL;
+    }
+
+    return cht->scratch;
+}
+
 /*
  * Function to retrieve the value associated with a key from the hash table
  * The key size is also needed for the hashing and the correct reading of data from the pointer
+ * Values stored compressed are only decompressed here, see nodeValue
  */
 void* get(struct ChainedHashTable* cht, void* key, size_t key_size) {
     int index = hash(key, key_size, cht->size);
@@ -171,7 +522,7 @@ void* get(struct ChainedHashTable* cht, void* key, size_t key_size) {
     struct Node* current = cht->table[index];
     while (current != NULL) {
         if (memcmp(current->key, key, key_size) == 0) {
-            return current->value;
+            return nodeValue(cht, current);
         }
         current = current->next;
     }
@@ -195,9 +546,8 @@ void delete(struct ChainedHashTable* cht, void* key, size_t key_size) {
     if (memcmp(cht->table[index]->key, key, key_size) == 0) {
         struct Node* temp = cht->table[index];
         cht->table[index] = cht->table[index]->next;
-        free(temp->key);
-        free(temp->value);
-        free(temp);
+        freeNodeValue(temp, cht->compress_threshold, &cht->stats);
+        freeNode(temp);
         return;
     }
     
@@ -210,6 +560,7 @@ void delete(struct ChainedHashTable* cht, void* key, size_t key_size) {
     if (current->next != NULL) {
         struct Node* temp = current->next;
         current->next = current->next->next;
+        freeNodeValue(temp, cht->compress_threshold, &cht->stats);
         freeNode(temp);
     }
 }
@@ -223,13 +574,33 @@ void freeHashTable(struct ChainedHashTable* cht) {
         while (current != NULL) {
             struct Node* temp = current;
             current = current->next;
+            freeNodeValue(temp, cht->compress_threshold, &cht->stats);
             freeNode(temp);
         }
     }
     free(cht->table);
+    free(cht->scratch);
     free(cht);
 }
 
+/*
+ * Helper function to print the key and value of a single node as (key, value)
+ */
+void printNode(struct ChainedHashTable* cht, struct Node* node) {
+    if(node->key_size == sizeof(int)) {
+        printf("(%d", *(int*)node->key);
+    } else {
+        printf("(%s", (char*)node->key);
+    }
+
+    void* value = nodeValue(cht, node);
+    if(node->value_size == sizeof(int)) {
+        printf(", %d)", *(int*)value);
+    } else {
+        printf(", %s)", (char*)value);
+    }
+}
+
 /*
  * Helper function to to conviniently print the hash table
  */
@@ -238,56 +609,435 @@ void printHashTable(struct ChainedHashTable* cht) {
         printf("Bucket %d: ", i);
         struct Node* current = cht->table[i];
         while (current != NULL) {
-            if(current->key_size == sizeof(int)) {
-                printf("(%d", *(int*)current->key);
-            } else {
-                printf("(%s", (char*)current->key);
+            printNode(cht, current);
+            printf(" -> ");
+            current = current->next;
+        }
+        printf("NULL\n");
+    }
+}
+
+/*
+ * Helper function to print the counters of the value compression
+ */
+void printCompressionStats(struct ChainedHashTable* cht) {
+    struct CompressionStats* stats = &cht->stats;
+
+    printf("Compression threshold: %zu bytes%s\n", cht->compress_threshold, cht->compress_threshold == 0 ? " (disabled)" : "");
+    printf("Stored compressed values: %zu (%zu bytes -> %zu bytes, ratio %.2f)\n",
+        stats->compressed_values, stats->raw_bytes, stats->stored_bytes,
+        stats->stored_bytes == 0 ? 0.0 : (double)stats->raw_bytes / stats->stored_bytes);
+    printf("Stored incompressible values: %zu\n", stats->incompressible_values);
+    printf("Compressions (cumulative): %zu\n", stats->compress_calls);
+    printf("Compression CPU time (cumulative, sampled): %.6f s\n", stats->compress_seconds);
+    printf("Decompressions (cumulative): %zu\n", stats->decompressed_values);
+    printf("Decompression CPU time (cumulative, sampled): %.6f s\n", stats->decompress_seconds);
+}
+
+/*
+ * Helper function to print a single node of a scan page
+ */
+void printScanNode(struct ChainedHashTable* cht, struct Node* node) {
+    printNode(cht, node);
+    printf("\n");
+}
+
+/*
+ * Function to incrementally iterate over the hash table
+ *
+ * The cursor is the index of the next bucket to visit, start with 0.
+ * Every call visits whole buckets until at least count keys were returned
+ * or count * SCAN_EMPTY_BUCKETS_FACTOR buckets were visited, so the work per
+ * step stays bounded and other requests can be served in between.
+ * Since a bucket is never split between two pages, keys that are present
+ * during the whole iteration are always returned, even if other keys are
+ * inserted or deleted between the steps.
+ *
+ * If prefix is not NULL, only keys starting with it are passed to visit.
+ * Returns the cursor for the next call, 0 when the iteration is complete.
+ */
+size_t scan(struct ChainedHashTable* cht, size_t cursor, size_t count, char* prefix, void (*visit)(struct ChainedHashTable*, struct Node*)) {
+    if (prefix == NULL) {
+        prefix = "";
+    }
+    if (count == 0) {
+        count = 1;
+    }
+
+    size_t prefix_size = strlen(prefix);
+    size_t max_buckets = count * SCAN_EMPTY_BUCKETS_FACTOR;
+    size_t returned = 0;
+
+    // cursor from a table that was bigger before -> nothing left to visit
+    if (cursor >= cht->size) {
+        return 0;
+    }
+
+    while (cursor < cht->size && returned < count && max_buckets > 0) {
+        struct Node* current = cht->table[cursor];
+        while (current != NULL) {
+            if (current->key_size > prefix_size && memcmp(current->key, prefix, prefix_size) == 0) {
+                visit(cht, current);
+                returned++;
+            }
+            current = current->next;
+        }
+
+        cursor++;
+        max_buckets--;
+    }
+
+    return cursor < cht->size ? cursor : 0;
+}
+
+/*
+ * Helper function to create a node from a key and a value that are not
+ * null terminated (e.g. lines of a mapped file)
+ * Both are stored as strings, such that they are hashed and compared the
+ * same way as the ones sent by the client
+ */
+struct Node* createNodeFromText(char* key, size_t key_length, char* value, size_t value_length) {
+    struct Node* newNode = (struct Node*)malloc(sizeof(struct Node));
+    newNode->key = malloc(key_length + 1);
+    newNode->key_size = key_length + 1;
+    newNode->value = malloc(value_length + 1);
+    newNode->value_size = value_length + 1;
+    newNode->compressed = 0;
+    newNode->stored_size = value_length + 1;
+    newNode->next = NULL;
+
+    memcpy(newNode->key, key, key_length);
+    ((char*)newNode->key)[key_length] = '\0';
+    memcpy(newNode->value, value, value_length);
+    ((char*)newNode->value)[value_length] = '\0';
+
+    return newNode;
+}
+
+/*
+ * Helper function to link an already created node into its bucket
+ * If the key already exists, the value of the new node replaces the old one
+ * Returns 1 if the node was added as a new entry, 0 if it replaced a value
+ */
+int linkNode(struct ChainedHashTable* cht, struct Node* node, struct CompressionStats* stats) {
+    int index = hash(node->key, node->key_size, cht->size);
+
+    struct Node* current = cht->table[index];
+    while (current != NULL) {
+        if (current->key_size == node->key_size && memcmp(current->key, node->key, node->key_size) == 0) {
+            replaceNodeValue(current, node, cht->compress_threshold, stats);
+            return 0;
+        }
+        current = current->next;
+    }
+
+    node->next = cht->table[index];
+    cht->table[index] = node;
+
+    return 1;
+}
+
+/*
+ * State of a single thread of the parallel bulk load
+ *
+ * In the first phase every worker parses its own chunk of the mapped file
+ * and appends the created nodes to one list per partition (a contiguous range
+ * of buckets). In the second phase every worker links the nodes of its own
+ * partition, coming from all workers, into the table.
+ * No worker ever touches a bucket of another one, so no locks are needed.
+ */
+struct BulkLoadWorker {
+    struct ChainedHashTable* cht;
+    struct BulkLoadWorker* workers;
+    int id;
+    int worker_count;
+    // chunk of the mapped file parsed by this worker
+    char* begin;
+    char* end;
+    size_t parsed_lines;
+    // distinct keys linked into the table, duplicate lines are not counted
+    size_t linked_nodes;
+    // merged into the stats of the table once all workers are done
+    struct CompressionStats stats;
+    // first and last node of each partition, keeping the order of the file
+    struct Node** partition_heads;
+    struct Node** partition_tails;
+};
+
+/*
+ * First phase of the bulk load: parse lines in the form key\tvalue\n
+ * Lines without a tab are skipped
+ */
+void* bulkLoadParse(void* arg) {
+    struct BulkLoadWorker* worker = (struct BulkLoadWorker*)arg;
+    size_t table_size = worker->cht->size;
+    char* line = worker->begin;
+
+    while (line < worker->end) {
+        char* line_end = memchr(line, '\n', worker->end - line);
+        if (line_end == NULL) {
+            line_end = worker->end;
+        }
+
+        char* separator = memchr(line, '\t', line_end - line);
+        if (separator != NULL) {
+            char* value = separator + 1;
+            size_t value_length = line_end - value;
+            // tolerate files with windows line endings
+            if (value_length > 0 && value[value_length - 1] == '\r') {
+                value_length--;
             }
 
-            if(current->value_size == sizeof(int)) {
-                printf(", %d) -> ", *(int*)current->value);
+            struct Node* node = createNodeFromText(line, separator - line, value, value_length);
+            compressNodeValue(node, worker->cht->compress_threshold, &worker->stats);
+            size_t index = hash(node->key, node->key_size, table_size);
+            size_t partition = index * worker->worker_count / table_size;
+
+            if (worker->partition_heads[partition] == NULL) {
+                worker->partition_heads[partition] = node;
             } else {
-                printf(", %s) -> ", (char*)current->value);
+                worker->partition_tails[partition]->next = node;
             }
-            current = current->next;
+            worker->partition_tails[partition] = node;
+            worker->parsed_lines++;
+        }
+
+        line = line_end + 1;
+    }
+
+    return NULL;
+}
+
+/*
+ * Second phase of the bulk load: link the nodes of the worker's partition
+ * The workers are visited in the order of their chunks, so for duplicate keys
+ * the last line of the file wins, same as with consecutive inserts
+ */
+void* bulkLoadLink(void* arg) {
+    struct BulkLoadWorker* worker = (struct BulkLoadWorker*)arg;
+
+    for (int i = 0; i < worker->worker_count; i++) {
+        struct Node* current = worker->workers[i].partition_heads[worker->id];
+        while (current != NULL) {
+            struct Node* next = current->next;
+            current->next = NULL;
+            worker->linked_nodes += linkNode(worker->cht, current, &worker->stats);
+            current = next;
         }
-        printf("NULL\n");
     }
+
+    return NULL;
 }
 
 /*
- * Helper method to retrieve the Hash table size from the cmd options
+ * Helper function to get the maximum number of bulk load threads
  */
-int getTableSize(int argc, char **argv) {
+int maxBulkLoadThreads() {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return (cpus < 1 ? 1 : (int)cpus) * BULK_LOAD_THREADS_PER_CPU;
+}
+
+/*
+ * Helper function to run one phase of the bulk load on all workers
+ */
+void runBulkLoadPhase(struct BulkLoadWorker* workers, int worker_count, void* (*phase)(void*)) {
+    pthread_t threads[worker_count];
+
+    for (int i = 0; i < worker_count; i++) {
+        if (pthread_create(&threads[i], NULL, phase, &workers[i]) != 0) {
+            perror("ATTENTION: Bulk load thread cannot be created!");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    for (int i = 0; i < worker_count; i++) {
+        pthread_join(threads[i], NULL);
+    }
+}
+
+/*
+ * Function to build a new hash table of given size from a TSV file (key\tvalue per line)
+ *
+ * The file is memory mapped and split in chunks at line boundaries, which are
+ * parsed and linked into the table by thread_count threads in parallel.
+ * Returns NULL if the file cannot be read.
+ */
+struct ChainedHashTable* loadHashTable(char* path, size_t size, int thread_count, size_t compress_threshold) {
+    struct timespec start, finish;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    if (size == 0) {
+        fprintf(stderr, "ATTENTION: Bulk load needs a hash table with at least one bucket!\n");
+        return NULL;
+    }
+
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) {
+        perror("ATTENTION: Bulk load file cannot be opened!");
+        return NULL;
+    }
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) == -1) {
+        perror("ATTENTION: Bulk load file cannot be read!");
+        close(fd);
+        return NULL;
+    }
+
+    struct ChainedHashTable* cht = initializeHashTable(size);
+    cht->compress_threshold = compress_threshold;
+    size_t file_size = file_stat.st_size;
+    if (file_size == 0) {
+        close(fd);
+        return cht;
+    }
+
+    char* data = mmap(NULL, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+        perror("ATTENTION: Bulk load file cannot be mapped!");
+        close(fd);
+        freeHashTable(cht);
+        return NULL;
+    }
+    madvise(data, file_size, MADV_SEQUENTIAL);
+
+    // no point in having more workers than buckets, every worker owns a partition,
+    // or more workers than bytes, every worker needs a chunk of the file
+    if (thread_count > maxBulkLoadThreads()) {
+        thread_count = maxBulkLoadThreads();
+    }
+    if (thread_count > size) {
+        thread_count = size;
+    }
+    if (thread_count > file_size) {
+        thread_count = file_size;
+    }
+
+    struct BulkLoadWorker workers[thread_count];
+    char* data_end = data + file_size;
+    for (int i = 0; i < thread_count; i++) {
+        workers[i].cht = cht;
+        workers[i].workers = workers;
+        workers[i].id = i;
+        workers[i].worker_count = thread_count;
+        workers[i].parsed_lines = 0;
+        workers[i].linked_nodes = 0;
+        memset(&workers[i].stats, 0, sizeof(workers[i].stats));
+        workers[i].partition_heads = (struct Node**)calloc(thread_count, sizeof(struct Node*));
+        workers[i].partition_tails = (struct Node**)calloc(thread_count, sizeof(struct Node*));
+
+        // move the beginning of the chunk after the next line break, the previous worker parses that line
+        char* begin = data + file_size / thread_count * i;
+        if (i > 0 && begin > data && begin[-1] != '\n') {
+            begin = memchr(begin, '\n', data_end - begin);
+            begin = begin == NULL ? data_end : begin + 1;
+        }
+        if (i > 0) {
+            // very long lines can make the previous chunk start behind the current one
+            if (begin < workers[i - 1].begin) {
+                begin = workers[i - 1].begin;
+            }
+            workers[i - 1].end = begin;
+        }
+        workers[i].begin = begin;
+    }
+    workers[thread_count - 1].end = data_end;
+
+    runBulkLoadPhase(workers, thread_count, bulkLoadParse);
+    runBulkLoadPhase(workers, thread_count, bulkLoadLink);
+
+    size_t parsed_lines = 0;
+    size_t linked_nodes = 0;
+    for (int i = 0; i < thread_count; i++) {
+        parsed_lines += workers[i].parsed_lines;
+        linked_nodes += workers[i].linked_nodes;
+        addCompressionStats(&cht->stats, &workers[i].stats);
+        free(workers[i].partition_heads);
+        free(workers[i].partition_tails);
+    }
+
+    munmap(data, file_size);
+    close(fd);
+
+    clock_gettime(CLOCK_MONOTONIC, &finish);
+    double elapsed = (finish.tv_sec - start.tv_sec) + (finish.tv_nsec - start.tv_nsec) / 1e9;
+    fprintf(stdout, "Loaded %zu entries (%zu lines) from %s in %.3f s using %d threads\n", linked_nodes, parsed_lines, path, elapsed, thread_count);
+
+    return cht;
+}
+
+/*
+ * Options of the server given via the command line
+ */
+struct ServerOptions {
+    int table_size;
+    // optional TSV file used to fill the hash table on startup
+    char *load_path;
+    // number of threads used for bulk loading
+    int thread_count;
+    // values of at least this many bytes are stored compressed, 0 disables the compression
+    size_t compress_threshold;
+};
+
+void printServerUsageAndExit(char *executable) {
+    fprintf(stderr, "Usage:\n %s -s <size> [-l <file>] [-t <threads>] [-c <bytes>]\n", executable);
+    fprintf(stderr, "%s --size <size> [--load <file>] [--threads <threads>] [--compress-threshold <bytes>]\n", executable);
+    exit(EXIT_FAILURE);
+}
+
+/*
+ * Helper method to retrieve the Hash table size and the other server options from the cmd options
+ */
+struct ServerOptions getServerOptions(int argc, char **argv) {
     int long_option;
     char *opt_value = NULL;
+    struct ServerOptions options = {0, NULL, (int)sysconf(_SC_NPROCESSORS_ONLN), 0};
     static struct option long_options[] = {
         {"size", required_argument, NULL, 's'},
+        {"load", required_argument, NULL, 'l'},
+        {"threads", required_argument, NULL, 't'},
+        {"compress-threshold", required_argument, NULL, 'c'},
         {"help", no_argument, NULL, 'h'},
         {NULL, 0, NULL, 0}
     };
 
-    while ((long_option = getopt_long(argc, argv, "s:h", long_options, NULL)) != -1) {
+    while ((long_option = getopt_long(argc, argv, "s:l:t:c:h", long_options, NULL)) != -1) {
         switch (long_option) {
             case 's':
                 opt_value = optarg;
                 break;
+            case 'l':
+                options.load_path = optarg;
+                break;
+            case 't':
+                options.thread_count = atoi(optarg);
+                break;
+            case 'c':
+                options.compress_threshold = strtoul(optarg, NULL, 10);
+                break;
             case 'h':
-                fprintf(stderr, "Usage: %s -s <size>\n", argv[0]);
-                fprintf(stderr, "%s --size <size>\n", argv[0]);
-                exit(EXIT_FAILURE);
+                printServerUsageAndExit(argv[0]);
         }
     }
 
     if(opt_value == NULL) {
         fprintf(stderr, "Size parameter is required.\n");
-        fprintf(stderr, "Usage:\n %s -s <size>\n", argv[0]);
-        fprintf(stderr, "%s --size <size>\n", argv[0]);
-        exit(EXIT_FAILURE);
+        printServerUsageAndExit(argv[0]);
     }
 
     // Convert the size argument to an integer
-    return atoi(opt_value);
+    options.table_size = atoi(opt_value);
+
+    if(options.thread_count < 1) {
+        options.thread_count = 1;
+    }
+
+    if(options.thread_count > maxBulkLoadThreads()) {
+        fprintf(stderr, "Threads parameter must not be bigger than %d.\n", maxBulkLoadThreads());
+        printServerUsageAndExit(argv[0]);
+    }
+
+    return options;
 }
 
 /*
@@ -337,7 +1087,7 @@ void unlinkNamedSemaphore(sem_t *named_sem) {
  * Listening for incoming client requests
  * Parsing and executing the requests found
  */
-void startListening(struct ChainedHashTable* cht, char* shm) {
+void startListening(struct ChainedHashTable* cht, char* shm, int thread_count) {
     // create named semapthore to be able to sync different processes accessing the shm
     // alternative: use unnamed semaphore and store it in another shm to be accessible by all processes
     sem_t *named_sem = createOrOpenNamedSemaphore();
@@ -451,14 +1201,59 @@ void startListening(struct ChainedHashTable* cht, char* shm) {
             if (shouldFree) {
                 free(key);
             }
+        } else if (strcmp(operation, "c") == 0) {
+            // command is in the form cursor\ncount(\nprefix)?
+            char *count_string = NULL;
+            size_t cursor = strtoul(key_value_string, &count_string, 10);
+            if(*count_string != '\n') {
+                fprintf(stderr, "Invalid scan cursor in command: %s", cmd);
+                releaseNamedSemaphore(named_sem);
+                continue;
+            }
+
+            char *prefix = NULL;
+            size_t count = strtoul(++count_string, &prefix, 10);
+            if(*prefix == '\n') {
+                prefix++;
+            } else {
+                prefix = NULL;
+            }
+
+            printf("Scan page:\n");
+            size_t next_cursor = scan(cht, cursor, count, prefix, printScanNode);
+            printf("Next cursor: %zu\n", next_cursor);
+        } else if (strcmp(operation, "l") == 0) {
+            // the rest of the command is the path of the file to load
+            fprintf(stdout, "load: %s\n", key_value_string);
+
+            // the new table is built completely before it replaces the current content,
+            // so other commands see either the old or the new content
+            struct ChainedHashTable* loaded = loadHashTable(key_value_string, cht->size, thread_count, cht->compress_threshold);
+            if(loaded != NULL) {
+                // the counters of the stored values now describe the loaded table,
+                // only the cumulative ones keep counting
+                struct CompressionStats old_stats = cht->stats;
+                struct Node** old_table = cht->table;
+                cht->table = loaded->table;
+                cht->stats = loaded->stats;
+                cht->stats.compress_calls += old_stats.compress_calls;
+                cht->stats.decompressed_values += old_stats.decompressed_values;
+                cht->stats.compress_seconds += old_stats.compress_seconds;
+                cht->stats.decompress_seconds += old_stats.decompress_seconds;
+                loaded->table = old_table;
+                loaded->stats = old_stats;
+                freeHashTable(loaded);
+            }
+        } else if (strcmp(operation, "t") == 0) {
+            printCompressionStats(cht);
         } else {
             fprintf(stderr, "Invalid command: %s", cmd);
             releaseNamedSemaphore(named_sem);
             continue;
         }
 
-        /* Comment out for debugging */
-        printHashTable(cht);
+        /* Comment out for debugging, use the scan command for big tables */
+        // printHashTable(cht);
         // fprintf(stdout, "CMD: %s", shm);
 
         free(operation);
@@ -471,10 +1266,19 @@ void startListening(struct ChainedHashTable* cht, char* shm) {
  
 int main(int argc, char **argv) {
 
-    int table_size = getTableSize(argc, argv);
+    struct ServerOptions options = getServerOptions(argc, argv);
     
-    // Initialize the hash table
-    struct ChainedHashTable* cht = initializeHashTable(table_size);
+    // Initialize the hash table, either empty or from the given file
+    struct ChainedHashTable* cht = NULL;
+    if(options.load_path != NULL) {
+        cht = loadHashTable(options.load_path, options.table_size, options.thread_count, options.compress_threshold);
+        if(cht == NULL) {
+            exit(EXIT_FAILURE);
+        }
+    } else {
+        cht = initializeHashTable(options.table_size);
+        cht->compress_threshold = options.compress_threshold;
+    }
 
     int shm_id;
     char *shm;  
@@ -495,7 +1299,7 @@ int main(int argc, char **argv) {
         exit(EXIT_FAILURE);
     }
 
-    startListening(cht, shm);
+    startListening(cht, shm, options.thread_count);
 
     freeHashTable(cht);
   